@@ -1,46 +1,53 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <random>
 #include "graph.h"
+#include "generators.h"
 
-std::random_device random_device;
-std::mt19937_64 gen(random_device());
-std::uniform_real_distribution<> distribution(0.0, 1.0);
+constexpr uint64_t kSeed = 2024;
 
-template<size_t n>
-Graph<n> GenerateRandomGraph(float p = 0.5) {
-  std::vector<std::bitset<n>> adj_matrix(n);
-  for (size_t i = 0; i < n; ++i) {
-    for (size_t j = i + 1; j < n; ++j) {
-      if (distribution(gen) <= p) {
-        adj_matrix[i].set(j);
-        adj_matrix[j].set(i);
-      }
-    }
-  }
-  return Graph<n>(std::move(adj_matrix));
-}
+// Samples are split between threads, but every sample draws its graph from the
+// random stream of its (density, sample) pair, so the result depends only on the
+// seed and not on the number of threads
 
 template<size_t n>
-void GenerateAverageMaxAnticliqueNumberDistribution(std::string filename, float density = 0.01, size_t k = 5000) {
+void GenerateAverageMaxAnticliqueNumberDistribution(std::string filename, float density = 0.01, size_t k = 5000,
+                                                    size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
   std::ofstream output_file(filename);
-  std::vector<std::vector<size_t>> results(1 + n * (n - 1) / 2);
+  std::vector<float> densities;
   for (float p = 0.0; p <= 1; p += density) {
-    std::cout << p << '\n';
-    for (int i = 0; i < k; ++i) {
-      auto graph = GenerateRandomGraph<n>(p);
-      auto anticliques = graph.ListAllMaxAnticliques();
-      results[graph.EdgeCount()].push_back(anticliques.size());
-    }
+    densities.push_back(p);
+  }
+  std::vector<std::vector<std::vector<size_t>>> thread_results(threads, std::vector<std::vector<size_t>>(1 + n * (n - 1) / 2));
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      auto& results = thread_results[t];
+      for (size_t p_index = 0; p_index < densities.size(); ++p_index) {
+        for (size_t i = t; i < k; i += threads) {
+          std::mt19937_64 gen = MakeRandomStream(kSeed, p_index * k + i);
+          auto graph = GenerateRandomGraph<n>(densities[p_index], gen);
+          auto anticliques = graph.ListAllMaxAnticliques();
+          results[graph.EdgeCount()].push_back(anticliques.size());
+        }
+      }
+    });
   }
-  for (auto group : results) {
-    size_t sum = 0;
-    for (auto value : group) {
-      sum += value;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (size_t edges = 0; edges < thread_results[0].size(); ++edges) {
+    size_t sum = 0, count = 0;
+    for (const auto& results : thread_results) {
+      for (auto value : results[edges]) {
+        sum += value;
+      }
+      count += results[edges].size();
     }
-    output_file << static_cast<float>(sum) / group.size() << '\n';
+    output_file << static_cast<float>(sum) / count << '\n';
   }
 }
 
@@ -2,36 +2,18 @@
 #include <random>
 #include <bitset>
 #include "graph.h"
+#include "generators.h"
 
 
-std::random_device random_device;
-std::mt19937_64 gen(random_device());
-std::uniform_real_distribution<> distribution(0.0, 1.0);
-
-
-// Generates random graph G(n, p) from Erdos-Renyi model
-
-template<size_t n>
-Graph<n> GenerateRandomGraph(float p = 0.5) {
-  std::vector<std::bitset<n>> adj_matrix(n);
-  for (size_t i = 0; i < n; ++i) {
-    for (size_t j = i + 1; j < n; ++j) {
-      if (distribution(gen) <= p) {
-        adj_matrix[i].set(j);
-        adj_matrix[j].set(i);
-      }
-    }
-  }
-  return Graph<n>(std::move(adj_matrix));
-}
-
+constexpr uint64_t kSeed = 2024;
 
 template <size_t n>
 static void BM_Check3Coloring(benchmark::State& state) {
   float p = static_cast<float>(state.range(0)) / 4.0;
+  std::mt19937_64 gen = MakeRandomStream(kSeed, n);
   for (auto _ : state) {
     state.PauseTiming();
-    Graph<n> graph = GenerateRandomGraph<n>(p);
+    Graph<n> graph = GenerateRandomGraph<n>(p, gen);
     state.ResumeTiming();
     bool is3col = graph.Check3Coloring();
     benchmark::DoNotOptimize(is3col);
@@ -39,55 +21,6 @@ static void BM_Check3Coloring(benchmark::State& state) {
   }
 }
 
-// Generates graph with the greatest number of maximal anticliques
-
-template <size_t n>
-Graph<n> GenerateMaxGraph() {
-  std::vector<std::bitset<n>> adj_matrix(n);
-  if (n % 3 == 0) {
-    for (size_t i = 0; i < n; i += 3) {
-      adj_matrix[i].set(i + 1);
-      adj_matrix[i].set(i + 2);
-      adj_matrix[i + 1].set(i);
-      adj_matrix[i + 1].set(i + 2);
-      adj_matrix[i + 2].set(i);
-      adj_matrix[i + 2].set(i + 1);
-    }
-  }
-  if (n % 3 == 1 && n > 3) {
-    for (size_t j = 0; j < 4; ++j) {
-      for (size_t k = 0; k < 4; ++k) {
-        if (j != k) {
-          adj_matrix[j].set(k);
-          adj_matrix[k].set(j);
-        }
-      }
-    }
-    for (size_t i = 4; i < n; i += 3) {
-      adj_matrix[i].set(i + 1);
-      adj_matrix[i].set(i + 2);
-      adj_matrix[i + 1].set(i);
-      adj_matrix[i + 1].set(i + 2);
-      adj_matrix[i + 2].set(i);
-      adj_matrix[i + 2].set(i + 1);
-    }
-  }
-  if (n % 3 == 2) {
-    adj_matrix[0].set(1);
-    adj_matrix[1].set(0);
-    for (size_t i = 2; i < n; i += 3) {
-      adj_matrix[i].set(i + 1);
-      adj_matrix[i].set(i + 2);
-      adj_matrix[i + 1].set(i);
-      adj_matrix[i + 1].set(i + 2);
-      adj_matrix[i + 2].set(i);
-      adj_matrix[i + 2].set(i + 1);
-    }
-  }
-  return Graph<n>(std::move(adj_matrix));
-}
-
-
 template <size_t n>
 static void BM_Check3ColoringMaxAnticliques(benchmark::State& state) {
   Graph<n> graph = GenerateMaxGraph<n>();
@@ -98,6 +31,21 @@ static void BM_Check3ColoringMaxAnticliques(benchmark::State& state) {
   }
 }
 
+template <size_t n>
+static void BM_GenerateRandomGraph(benchmark::State& state) {
+  double p = static_cast<double>(state.range(0)) / 64.0;
+  std::mt19937_64 gen = MakeRandomStream(kSeed, n);
+  for (auto _ : state) {
+    Graph<n> graph = GenerateRandomGraph<n>(p, gen);
+    benchmark::DoNotOptimize(graph);
+  }
+}
+
+// G(n, p) generation, density in 1/64 units
+
+BENCHMARK_TEMPLATE(BM_GenerateRandomGraph, 50ull)->Arg(1)->Arg(4)->Arg(16)->Arg(32)->Arg(48);
+BENCHMARK_TEMPLATE(BM_GenerateRandomGraph, 100ull)->Arg(1)->Arg(4)->Arg(16)->Arg(32)->Arg(48);
+
 // G(n, p) model tests
 
 BENCHMARK_TEMPLATE(BM_Check3Coloring, 3ull)->Arg(1)->Arg(2)->Arg(3);
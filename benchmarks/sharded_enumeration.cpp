@@ -0,0 +1,494 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "anticlique_enumerator.h"
+#include "graph_io.h"
+
+// Lists maximal anticliques of a graph split into shards, every shard is a
+// separate process that periodically checkpoints into the working directory
+// and resumes from the checkpoint when restarted.
+//
+// Usage:
+//   run_sharded_enumeration <graph> <work_dir> <shards>              runs all shards as child processes and merges
+//   run_sharded_enumeration <graph> <work_dir> <shards> --shard <i>  runs or resumes a single shard
+//   run_sharded_enumeration <graph> <work_dir> <shards> --merge      merges results of finished shards
+//
+// Options:
+//   --list                      also write the anticliques, merged into <work_dir>/merged.list; the merge
+//                               streams the shard lists keeping one file open per sorted run (about 8 per
+//                               shard) and merges in several passes when the runs exceed the open file limit
+//   --checkpoint-seconds <s>    checkpoint interval, 60 by default
+//
+// The graph file starts with the number of vertices and edges "n m" followed by
+// m lines "u v" with vertices numbered from 1.
+
+namespace fs = std::filesystem;
+
+constexpr size_t kCandidatesPerClockCheck = 4096;
+
+// Descriptors left to the standard streams and the merge output, and the most
+// runs merged in a single pass
+constexpr size_t kReservedDescriptors = 16;
+constexpr size_t kMaxRunsPerPass = 1024;
+
+struct Options {
+  std::string graph_path;
+  fs::path work_dir;
+  size_t shard_count = 1;
+  size_t shard_index = 0;
+  bool run_shard = false;
+  bool merge_only = false;
+  bool list = false;
+  size_t checkpoint_seconds = 60;
+};
+
+// Identifies the run a shard belongs to, results of another graph or another
+// split of the same graph must not be reused
+
+struct RunIdentity {
+  uint64_t fingerprint = 0;
+  size_t vertices = 0;
+  size_t shard_count = 0;
+
+  bool operator==(const RunIdentity& other) const = default;
+};
+
+struct ShardSummary {
+  RunIdentity identity;
+  uint64_t count = 0;
+  bool colorable = false;
+  bool finished = false;
+  bool listed = false;
+};
+
+fs::path ShardPath(const Options& options, size_t shard, const std::string& extension) {
+  return options.work_dir / ("shard_" + std::to_string(shard) + extension);
+}
+
+ShardSummary ReadSummary(const fs::path& path) {
+  ShardSummary summary;
+  std::ifstream input(path);
+  input >> summary.identity.fingerprint >> summary.identity.vertices >> summary.identity.shard_count
+        >> summary.count >> summary.colorable >> summary.finished >> summary.listed;
+  if (!input) {
+    return ShardSummary();
+  }
+  return summary;
+}
+
+// Writes into a temporary file first, so a crash never leaves a torn file
+
+template<typename Writer>
+void WriteAtomically(const fs::path& path, Writer writer) {
+  fs::path temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+    writer(output);
+    output.flush();
+    if (!output) {
+      throw std::runtime_error("failed to write " + temporary.string());
+    }
+  }
+  fs::rename(temporary, path);
+}
+
+void WriteSummary(const fs::path& path, const ShardSummary& summary) {
+  WriteAtomically(path, [&](std::ostream& output) {
+    output << summary.identity.fingerprint << ' ' << summary.identity.vertices << ' ' << summary.identity.shard_count
+           << ' ' << summary.count << ' ' << summary.colorable << ' ' << summary.finished << ' ' << summary.listed
+           << '\n';
+  });
+}
+
+template<size_t n>
+std::string FormatAnticlique(const std::bitset<n>& anticlique, size_t vertices) {
+  std::string line(vertices, '0');
+  for (size_t i = 0; i < vertices; ++i) {
+    if (anticlique[i]) {
+      line[i] = '1';
+    }
+  }
+  return line;
+}
+
+template<size_t n>
+int RunShard(const Graph<n>& graph, size_t vertices, const Options& options) {
+  MaxAnticliqueEnumerator<n> enumerator(graph, options.shard_index, options.shard_count);
+  fs::path summary_path = ShardPath(options, options.shard_index, ".summary");
+  fs::path checkpoint_path = ShardPath(options, options.shard_index, ".ckpt");
+  fs::path list_path = ShardPath(options, options.shard_index, ".list");
+
+  RunIdentity identity{enumerator.Fingerprint(), vertices, options.shard_count};
+  ShardSummary summary = ReadSummary(summary_path);
+  // Left over from another run in the same directory, or run without --list
+  // and so missing the anticliques listed so far: start the shard over
+  if (summary.identity != identity || (options.list && !summary.listed)) {
+    fs::remove(checkpoint_path);
+    summary = ShardSummary();
+  }
+  if (summary.finished) {
+    return 0;
+  }
+  if (fs::exists(checkpoint_path)) {
+    std::ifstream checkpoint(checkpoint_path, std::ios::binary);
+    enumerator.LoadCheckpoint(checkpoint);
+  } else {
+    summary = ShardSummary();
+  }
+  summary.identity = identity;
+  summary.listed = options.list;
+
+  // Every line has the same width, so dropping lines written after the last
+  // checkpoint is a truncation
+  std::ofstream list;
+  if (options.list) {
+    std::ofstream(list_path, std::ios::app).close();
+    uintmax_t listed_size = enumerator.EmittedCount() * (vertices + 1);
+    if (fs::file_size(list_path) < listed_size) {
+      throw std::runtime_error(list_path.string() + " is shorter than the checkpoint");
+    }
+    fs::resize_file(list_path, listed_size);
+    list.open(list_path, std::ios::app);
+    if (!list) {
+      throw std::runtime_error("cannot open " + list_path.string());
+    }
+  }
+
+  auto interval = std::chrono::seconds(options.checkpoint_seconds);
+  auto last_checkpoint = std::chrono::steady_clock::now();
+  while (true) {
+    // Next gives up after a bounded number of rejected candidates, so the clock
+    // is checked even while the shard emits nothing
+    auto anticlique = enumerator.Next(kCandidatesPerClockCheck);
+    if (anticlique) {
+      if (!summary.colorable && graph.CheckRestIsBipartite(*anticlique)) {
+        summary.colorable = true;
+      }
+      if (options.list) {
+        list << FormatAnticlique(*anticlique, vertices) << '\n';
+      }
+    } else if (enumerator.Finished()) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() - last_checkpoint >= interval) {
+      list.flush();
+      if (options.list && !list) {
+        throw std::runtime_error("failed to write " + list_path.string());
+      }
+      // The colorability flag never goes back to false, so it is safe to
+      // save it ahead of the checkpoint it belongs to
+      summary.count = enumerator.EmittedCount();
+      WriteSummary(summary_path, summary);
+      WriteAtomically(checkpoint_path, [&](std::ostream& output) {
+        enumerator.SaveCheckpoint(output);
+      });
+      last_checkpoint = std::chrono::steady_clock::now();
+    }
+  }
+
+  list.close();
+  if (options.list && !list) {
+    throw std::runtime_error("failed to write " + list_path.string());
+  }
+  summary.count = enumerator.EmittedCount();
+  summary.finished = true;
+  WriteSummary(summary_path, summary);
+  fs::remove(checkpoint_path);
+  return 0;
+}
+
+EdgeList ReadGraph(const Options& options) {
+  std::ifstream input(options.graph_path);
+  if (!input) {
+    throw std::runtime_error("cannot open " + options.graph_path);
+  }
+  return ReadEdgeList(input);
+}
+
+RunIdentity ExpectedIdentity(const EdgeList& edges, const Options& options) {
+  uint64_t fingerprint = VisitPaddedGraph(edges, [](const auto& graph) {
+    return MaxAnticliqueEnumerator(graph).Fingerprint();
+  });
+  return RunIdentity{fingerprint, edges.vertices, options.shard_count};
+}
+
+// Every prefix of a shard is listed in ListAllMaxAnticliques order, so a shard
+// list is a concatenation of a few sorted runs. The runs of all shards are
+// merged as streams, keeping one line per run in memory.
+
+struct ListRun {
+  fs::path path;
+  uint64_t first_line = 0;
+  uint64_t lines = 0;
+};
+
+class ListRunReader {
+ public:
+  ListRunReader(const ListRun& run, size_t vertices) : run_(run), remaining_(run.lines) {
+    input_.open(run.path);
+    if (!input_) {
+      throw std::runtime_error("cannot open " + run.path.string() + ": " + std::strerror(errno));
+    }
+    input_.seekg(static_cast<std::streamoff>(run.first_line * (vertices + 1)));
+  }
+
+  bool Advance() {
+    if (remaining_ == 0) {
+      return false;
+    }
+    if (!std::getline(input_, line_)) {
+      throw std::runtime_error("unexpected end of " + run_.path.string());
+    }
+    --remaining_;
+    return true;
+  }
+
+  const std::string& Line() const {
+    return line_;
+  }
+
+ private:
+  ListRun run_;
+  std::ifstream input_;
+  std::string line_;
+  uint64_t remaining_;
+};
+
+void AppendListRuns(const fs::path& path, std::vector<ListRun>& runs) {
+  std::ifstream scan(path);
+  if (!scan) {
+    throw std::runtime_error("cannot open " + path.string() + ": " + std::strerror(errno));
+  }
+  std::string previous, line;
+  uint64_t index = 0, run_start = 0;
+  auto close_run = [&](uint64_t end) {
+    if (end > run_start) {
+      runs.push_back(ListRun{path, run_start, end - run_start});
+    }
+    run_start = end;
+  };
+  for (; std::getline(scan, line); ++index) {
+    if (index > 0 && line > previous) {
+      close_run(index);
+    }
+    previous = std::move(line);
+  }
+  if (!scan.eof()) {
+    throw std::runtime_error("failed to read " + path.string());
+  }
+  close_run(index);
+}
+
+// Merges the runs into a single run written to output_path
+
+ListRun MergeRuns(const std::vector<ListRun>& runs, size_t vertices, const fs::path& output_path) {
+  std::vector<std::unique_ptr<ListRunReader>> readers;
+  for (const auto& run : runs) {
+    readers.push_back(std::make_unique<ListRunReader>(run, vertices));
+  }
+  // Same order as ListAllMaxAnticliques: the set containing the smaller
+  // vertex goes first, which is the greater line
+  auto line_less = [&](size_t lhs, size_t rhs) {
+    return readers[lhs]->Line() < readers[rhs]->Line();
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(line_less)> heads(line_less);
+  for (size_t i = 0; i < readers.size(); ++i) {
+    if (readers[i]->Advance()) {
+      heads.push(i);
+    }
+  }
+  std::ofstream output(output_path);
+  if (!output) {
+    throw std::runtime_error("cannot open " + output_path.string() + ": " + std::strerror(errno));
+  }
+  ListRun merged{output_path, 0, 0};
+  while (!heads.empty()) {
+    size_t top = heads.top();
+    heads.pop();
+    output << readers[top]->Line() << '\n';
+    ++merged.lines;
+    if (readers[top]->Advance()) {
+      heads.push(top);
+    }
+  }
+  output.flush();
+  if (!output) {
+    throw std::runtime_error("failed to write " + output_path.string());
+  }
+  return merged;
+}
+
+// Number of runs that can be open at once under the open file limit
+
+size_t MaxRunsPerPass() {
+  rlimit limit{};
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) {
+    return kMaxRunsPerPass;
+  }
+  size_t available = limit.rlim_cur > kReservedDescriptors ? limit.rlim_cur - kReservedDescriptors : 0;
+  return std::clamp<size_t>(available, 2, kMaxRunsPerPass);
+}
+
+// Merges groups of runs into temporary files until the rest fits in one pass
+
+void MergeLists(const Options& options, size_t vertices) {
+  std::vector<ListRun> runs;
+  for (size_t shard = 0; shard < options.shard_count; ++shard) {
+    AppendListRuns(ShardPath(options, shard, ".list"), runs);
+  }
+  size_t runs_per_pass = MaxRunsPerPass();
+  std::vector<fs::path> temporaries;
+  for (size_t pass = 0; runs.size() > runs_per_pass; ++pass) {
+    std::vector<ListRun> merged;
+    std::vector<fs::path> pass_temporaries;
+    for (size_t first = 0; first < runs.size(); first += runs_per_pass) {
+      std::vector<ListRun> group(runs.begin() + first, runs.begin() + std::min(first + runs_per_pass, runs.size()));
+      fs::path path = options.work_dir / ("merge_" + std::to_string(pass) + "_" + std::to_string(merged.size()) + ".list");
+      merged.push_back(MergeRuns(group, vertices, path));
+      pass_temporaries.push_back(path);
+    }
+    for (const auto& path : temporaries) {
+      fs::remove(path);
+    }
+    temporaries = std::move(pass_temporaries);
+    runs = std::move(merged);
+  }
+  MergeRuns(runs, vertices, options.work_dir / "merged.list");
+  for (const auto& path : temporaries) {
+    fs::remove(path);
+  }
+}
+
+int Merge(const Options& options) {
+  RunIdentity identity = ExpectedIdentity(ReadGraph(options), options);
+  ShardSummary merged;
+  for (size_t shard = 0; shard < options.shard_count; ++shard) {
+    ShardSummary summary = ReadSummary(ShardPath(options, shard, ".summary"));
+    if (summary.identity != identity) {
+      std::cerr << "shard " << shard << " was run for another graph or number of shards\n";
+      return 1;
+    }
+    if (!summary.finished) {
+      std::cerr << "shard " << shard << " is not finished\n";
+      return 1;
+    }
+    if (options.list && !summary.listed) {
+      std::cerr << "shard " << shard << " was run without --list\n";
+      return 1;
+    }
+    if (options.list && fs::file_size(ShardPath(options, shard, ".list")) != summary.count * (identity.vertices + 1)) {
+      std::cerr << "list of shard " << shard << " does not match its summary\n";
+      return 1;
+    }
+    merged.count += summary.count;
+    merged.colorable = merged.colorable || summary.colorable;
+  }
+  if (options.list) {
+    MergeLists(options, identity.vertices);
+  }
+  std::cout << "anticliques: " << merged.count << '\n';
+  std::cout << "3-colorable: " << (merged.colorable ? "yes" : "no") << '\n';
+  return 0;
+}
+
+int RunAllShards(char** argv, const Options& options) {
+  std::vector<pid_t> children;
+  for (size_t shard = 0; shard < options.shard_count; ++shard) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      std::cerr << "fork failed\n";
+      return 1;
+    }
+    if (pid == 0) {
+      std::vector<std::string> arguments = {argv[0], options.graph_path, options.work_dir.string(),
+                                            std::to_string(options.shard_count), "--shard", std::to_string(shard),
+                                            "--checkpoint-seconds", std::to_string(options.checkpoint_seconds)};
+      if (options.list) {
+        arguments.push_back("--list");
+      }
+      std::vector<char*> child_argv;
+      for (auto& argument : arguments) {
+        child_argv.push_back(argument.data());
+      }
+      child_argv.push_back(nullptr);
+      execvp(child_argv[0], child_argv.data());
+      _exit(127);
+    }
+    children.push_back(pid);
+  }
+  bool failed = false;
+  for (size_t shard = 0; shard < children.size(); ++shard) {
+    int status = 0;
+    waitpid(children[shard], &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      std::cerr << "shard " << shard << " failed\n";
+      failed = true;
+    }
+  }
+  return failed ? 1 : Merge(options);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    std::cerr << "usage: " << argv[0] << " <graph> <work_dir> <shards> [--shard <i> | --merge] [--list]"
+              << " [--checkpoint-seconds <s>]\n";
+    return 1;
+  }
+  Options options;
+  options.graph_path = argv[1];
+  options.work_dir = argv[2];
+  options.shard_count = std::stoul(argv[3]);
+  for (int i = 4; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--shard" && i + 1 < argc) {
+      options.run_shard = true;
+      options.shard_index = std::stoul(argv[++i]);
+    } else if (argument == "--merge") {
+      options.merge_only = true;
+    } else if (argument == "--list") {
+      options.list = true;
+    } else if (argument == "--checkpoint-seconds" && i + 1 < argc) {
+      options.checkpoint_seconds = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "unknown argument " << argument << '\n';
+      return 1;
+    }
+  }
+  if (options.shard_count == 0 || options.shard_index >= options.shard_count) {
+    std::cerr << "shard index is out of range\n";
+    return 1;
+  }
+  fs::create_directories(options.work_dir);
+
+  try {
+    if (options.merge_only) {
+      return Merge(options);
+    }
+    if (!options.run_shard) {
+      return RunAllShards(argv, options);
+    }
+    EdgeList edges = ReadGraph(options);
+    return VisitPaddedGraph(edges, [&](const auto& graph) {
+      return RunShard(graph, edges.vertices, options);
+    });
+  } catch (const std::exception& error) {
+    if (options.run_shard) {
+      std::cerr << "shard " << options.shard_index << ": ";
+    }
+    std::cerr << error.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,176 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "generators.h"
+#include "graph_io.h"
+#include "solver_protocol.h"
+
+// Load generator for run_solver_server: sends random G(n, p) graphs in graph6
+// over several connections and reports client side throughput and latency.
+//
+// Usage:
+//   run_solver_load <socket> [--requests <N>] [--connections <c>] [--pipeline <d>]
+//                            [--vertices <n>] [--density <p>] [--query color|count] [--seed <s>]
+//
+// Every connection keeps up to d requests in flight, so with c * d larger than
+// the number of server threads requests get batched.
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+  std::string socket_path;
+  size_t requests = 1000;
+  size_t connections = 4;
+  size_t pipeline = 4;
+  size_t vertices = 20;
+  double density = 0.5;
+  std::string query = "color";
+  uint64_t seed = 1;
+};
+
+int ConnectUnixSocket(const std::string& path) {
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Sends this connection's share of requests, returns false on a protocol error
+
+bool RunConnection(size_t index, size_t requests, const Options& options, std::vector<double>& latencies) {
+  int fd = ConnectUnixSocket(options.socket_path);
+  if (fd < 0) {
+    std::cerr << "connection " << index << ": cannot connect to " << options.socket_path << '\n';
+    return false;
+  }
+  std::mt19937_64 gen = MakeRandomStream(options.seed, index);
+  std::vector<std::string> graphs;
+  for (size_t i = 0; i < requests; ++i) {
+    graphs.push_back(FormatGraph6(GenerateRandomEdgeList(options.vertices, options.density, gen)));
+  }
+
+  LineReader reader(fd);
+  std::unordered_map<size_t, Clock::time_point> in_flight;
+  size_t sent = 0, received = 0;
+  bool ok = true;
+  while (received < requests && ok) {
+    while (sent < requests && in_flight.size() < options.pipeline) {
+      in_flight[sent] = Clock::now();
+      ok = WriteAll(fd, std::to_string(sent) + " " + options.query + " g6 " + graphs[sent] + "\n");
+      ++sent;
+    }
+    std::string line;
+    if (!ok || !reader.ReadLine(line)) {
+      ok = false;
+      break;
+    }
+    std::istringstream response(line);
+    size_t id = 0;
+    std::string status;
+    response >> id >> status;
+    auto it = in_flight.find(id);
+    if (status != "ok" || it == in_flight.end()) {
+      std::cerr << "connection " << index << ": unexpected response " << line << '\n';
+      ok = false;
+      break;
+    }
+    latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - it->second).count());
+    in_flight.erase(it);
+    ++received;
+  }
+  close(fd);
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " <socket> [--requests <N>] [--connections <c>] [--pipeline <d>]"
+              << " [--vertices <n>] [--density <p>] [--query color|count] [--seed <s>]\n";
+    return 1;
+  }
+  Options options;
+  options.socket_path = argv[1];
+  for (int i = 2; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (i + 1 >= argc) {
+      std::cerr << "missing value for " << argument << '\n';
+      return 1;
+    }
+    std::string value = argv[++i];
+    if (argument == "--requests") {
+      options.requests = std::stoul(value);
+    } else if (argument == "--connections") {
+      options.connections = std::max(1ul, std::stoul(value));
+    } else if (argument == "--pipeline") {
+      options.pipeline = std::max(1ul, std::stoul(value));
+    } else if (argument == "--vertices") {
+      options.vertices = std::stoul(value);
+    } else if (argument == "--density") {
+      options.density = std::stod(value);
+    } else if (argument == "--query") {
+      options.query = value;
+    } else if (argument == "--seed") {
+      options.seed = std::stoull(value);
+    } else {
+      std::cerr << "unknown argument " << argument << '\n';
+      return 1;
+    }
+  }
+
+  std::vector<std::vector<double>> latencies(options.connections);
+  std::vector<char> succeeded(options.connections);
+  std::vector<std::thread> threads;
+  Clock::time_point started = Clock::now();
+  for (size_t i = 0; i < options.connections; ++i) {
+    size_t share = options.requests / options.connections + (i < options.requests % options.connections);
+    threads.emplace_back([&, i, share] {
+      succeeded[i] = RunConnection(i, share, options, latencies[i]);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+  std::vector<double> all;
+  for (const auto& connection_latencies : latencies) {
+    all.insert(all.end(), connection_latencies.begin(), connection_latencies.end());
+  }
+  std::sort(all.begin(), all.end());
+  std::cout << std::fixed << std::setprecision(1)
+            << "requests=" << all.size() << " elapsed_s=" << elapsed
+            << " throughput_rps=" << (elapsed > 0 ? all.size() / elapsed : 0)
+            << " p50_us=" << Percentile(all, 0.5) << " p90_us=" << Percentile(all, 0.9)
+            << " p99_us=" << Percentile(all, 0.99) << " max_us=" << (all.empty() ? 0 : all.back()) << '\n';
+
+  int fd = ConnectUnixSocket(options.socket_path);
+  if (fd >= 0) {
+    std::string line;
+    LineReader reader(fd);
+    if (WriteAll(fd, "stats\n") && reader.ReadLine(line)) {
+      std::cout << "server " << line << '\n';
+    }
+    close(fd);
+  }
+  return std::all_of(succeeded.begin(), succeeded.end(), [](char ok) { return ok; }) ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+
+#ifndef COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_PROTOCOL_H
+#define COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_PROTOCOL_H
+
+// Line based protocol of run_solver_server.
+//
+// Request:   <id> <query> g6 <graph6 string>
+//            <id> <query> edges <n> <m> <u1> <v1> ... <um> <vm>    (vertices numbered from 1)
+//            stats
+// Response:  <id> ok <result> <latency in microseconds>
+//            <id> error <message>
+//            stats completed=<c> errors=<e> throughput_rps=<r> p50_us=<..> p90_us=<..> p99_us=<..> max_us=<..>
+//
+// Query is either "color" with result "yes" or "no", or "count" with the number
+// of maximal anticliques. Responses come in the order requests finish. In stats
+// throughput is averaged over the last 10 seconds and percentiles are taken over
+// the latencies of the last 65536 requests.
+
+constexpr size_t kMaxLineLength = 1 << 20;
+
+class LineReader {
+ public:
+  explicit LineReader(int fd) : fd_(fd) {}
+
+  // Returns false on end of input, error or an overly long line
+
+  bool ReadLine(std::string& line) {
+    while (true) {
+      size_t newline = buffer_.find('\n');
+      if (newline != std::string::npos) {
+        line.assign(buffer_, 0, newline);
+        buffer_.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r') {
+          line.pop_back();
+        }
+        return true;
+      }
+      if (buffer_.size() > kMaxLineLength) {
+        return false;
+      }
+      char chunk[4096];
+      ssize_t received = read(fd_, chunk, sizeof(chunk));
+      if (received < 0 && errno == EINTR) {
+        continue;
+      }
+      if (received <= 0) {
+        if (buffer_.empty()) {
+          return false;
+        }
+        line = std::move(buffer_);
+        buffer_.clear();
+        return true;
+      }
+      buffer_.append(chunk, received);
+    }
+  }
+
+ private:
+  int fd_;
+  std::string buffer_;
+};
+
+inline bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t result = write(fd, data.data() + written, data.size() - written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    written += result;
+  }
+  return true;
+}
+
+// Nearest rank percentile of sorted values, q in [0, 1]
+
+inline double Percentile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+#endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_PROTOCOL_H
@@ -0,0 +1,249 @@
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "anticlique_enumerator.h"
+#include "graph_io.h"
+#include "solver_protocol.h"
+#include "solver_server.h"
+
+// Long running solver, keeps all Graph<n> instantiations warm and answers
+// requests from a Unix domain socket or from stdin (see solver_protocol.h).
+//
+// Usage:
+//   run_solver_server [--socket <path>] [--threads <k>] [--batch <b>] [--batch-window-us <w>] [--report-seconds <s>]
+//
+// Requests of all connections go to a single queue. Every worker takes up to
+// b requests at once, but no more than its share among the idle workers, so a
+// burst of small graphs costs one wakeup per batch instead of per request and
+// still keeps the whole pool busy. A nonzero w makes a worker wait up to w microseconds
+// for the batch to fill, trading latency under light load for larger batches.
+
+struct Options {
+  std::string socket_path;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t batch = 16;
+  size_t batch_window_us = 0;
+  size_t report_seconds = 0;
+};
+
+class Connection {
+ public:
+  Connection(int fd, bool owns_fd) : fd_(fd), owns_fd_(owns_fd) {}
+
+  ~Connection() {
+    if (owns_fd_) {
+      close(fd_);
+    }
+  }
+
+  void Send(const std::string& line) {
+    std::lock_guard lock(mutex_);
+    WriteAll(fd_, line + '\n');
+  }
+
+ private:
+  int fd_;
+  bool owns_fd_;
+  std::mutex mutex_;
+};
+
+struct Request {
+  std::string id;
+  std::string query;
+  EdgeList graph;
+  std::shared_ptr<Connection> connection;
+  Clock::time_point received;
+};
+
+// Check3Coloring and ListAllMaxAnticliques without materializing the list,
+// coloring stops at the first anticlique with a bipartite complement
+
+std::string Solve(const Request& request) {
+  return VisitPaddedGraph(request.graph, [&](const auto& graph) -> std::string {
+    MaxAnticliqueEnumerator enumerator(graph);
+    if (request.query == "color") {
+      while (auto anticlique = enumerator.Next()) {
+        if (graph.CheckRestIsBipartite(*anticlique)) {
+          return "yes";
+        }
+      }
+      return "no";
+    }
+    while (enumerator.Next()) {
+    }
+    return std::to_string(enumerator.EmittedCount());
+  });
+}
+
+Request ParseRequest(const std::string& line) {
+  Request request;
+  std::istringstream input(line);
+  std::string format;
+  if (!(input >> request.id >> request.query >> format)) {
+    throw std::invalid_argument("expected <id> <query> <format> <graph>");
+  }
+  if (request.query != "color" && request.query != "count") {
+    throw std::invalid_argument("unknown query " + request.query);
+  }
+  if (format == "g6") {
+    std::string text;
+    input >> text;
+    request.graph = ParseGraph6(text, kMaxPaddedVertices);
+  } else if (format == "edges") {
+    request.graph = ReadEdgeList(input, kMaxPaddedVertices);
+  } else {
+    throw std::invalid_argument("unknown format " + format);
+  }
+  return request;
+}
+
+void ServeConnection(int in_fd, std::shared_ptr<Connection> connection, BatchQueue<Request>& queue, LatencyStats& stats) {
+  LineReader reader(in_fd);
+  for (std::string line; reader.ReadLine(line);) {
+    Clock::time_point received = Clock::now();
+    if (line.empty()) {
+      continue;
+    }
+    if (line == "stats") {
+      connection->Send(stats.Report());
+      continue;
+    }
+    try {
+      Request request = ParseRequest(line);
+      request.connection = connection;
+      request.received = received;
+      queue.Push(std::move(request));
+    } catch (const std::exception& error) {
+      stats.RecordError();
+      std::string id = line.substr(0, line.find(' '));
+      connection->Send(id + " error " + error.what());
+    }
+  }
+}
+
+void RunWorker(BatchQueue<Request>& queue, LatencyStats& stats, const Options& options) {
+  while (true) {
+    std::vector<Request> batch = queue.PopBatch(options.batch, std::chrono::microseconds(options.batch_window_us));
+    if (batch.empty()) {
+      return;
+    }
+    for (const auto& request : batch) {
+      std::string result;
+      try {
+        result = Solve(request);
+      } catch (const std::exception& error) {
+        stats.RecordError();
+        request.connection->Send(request.id + " error " + error.what());
+        continue;
+      }
+      Clock::time_point finished = Clock::now();
+      double latency_us = std::chrono::duration<double, std::micro>(finished - request.received).count();
+      stats.Record(finished, latency_us);
+      request.connection->Send(request.id + " ok " + result + " " + std::to_string(static_cast<uint64_t>(latency_us)));
+    }
+  }
+}
+
+char socket_path_to_remove[sizeof(sockaddr_un::sun_path)];
+
+void RemoveSocketAndExit(int) {
+  unlink(socket_path_to_remove);
+  _exit(0);
+}
+
+int ListenUnixSocket(const std::string& path) {
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "socket path is too long\n";
+    return -1;
+  }
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    std::cerr << "socket: " << std::strerror(errno) << '\n';
+    return -1;
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+    std::cerr << "bind " << path << ": " << std::strerror(errno) << '\n';
+    close(fd);
+    return -1;
+  }
+  std::strncpy(socket_path_to_remove, path.c_str(), sizeof(socket_path_to_remove) - 1);
+  std::signal(SIGINT, RemoveSocketAndExit);
+  std::signal(SIGTERM, RemoveSocketAndExit);
+  return fd;
+}
+
+int main(int argc, char** argv) {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--socket" && i + 1 < argc) {
+      options.socket_path = argv[++i];
+    } else if (argument == "--threads" && i + 1 < argc) {
+      options.threads = std::max(1ul, std::stoul(argv[++i]));
+    } else if (argument == "--batch" && i + 1 < argc) {
+      options.batch = std::max(1ul, std::stoul(argv[++i]));
+    } else if (argument == "--batch-window-us" && i + 1 < argc) {
+      options.batch_window_us = std::stoul(argv[++i]);
+    } else if (argument == "--report-seconds" && i + 1 < argc) {
+      options.report_seconds = std::stoul(argv[++i]);
+    } else {
+      std::cerr << "usage: " << argv[0] << " [--socket <path>] [--threads <k>] [--batch <b>]"
+                << " [--batch-window-us <w>] [--report-seconds <s>]\n";
+      return 1;
+    }
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+
+  BatchQueue<Request> queue;
+  LatencyStats stats;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < options.threads; ++i) {
+    workers.emplace_back(RunWorker, std::ref(queue), std::ref(stats), std::cref(options));
+  }
+  if (options.report_seconds > 0) {
+    std::thread([&stats, &options] {
+      while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(options.report_seconds));
+        std::cerr << stats.Report() << std::endl;
+      }
+    }).detach();
+  }
+
+  if (options.socket_path.empty()) {
+    ServeConnection(STDIN_FILENO, std::make_shared<Connection>(STDOUT_FILENO, false), queue, stats);
+    queue.Close();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    return 0;
+  }
+
+  int listen_fd = ListenUnixSocket(options.socket_path);
+  if (listen_fd < 0) {
+    return 1;
+  }
+  while (true) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno != EINTR) {
+        std::cerr << "accept: " << std::strerror(errno) << '\n';
+      }
+      continue;
+    }
+    std::thread(ServeConnection, fd, std::make_shared<Connection>(fd, true), std::ref(queue), std::ref(stats)).detach();
+  }
+}
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "solver_protocol.h"
+
+
+#ifndef COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_SERVER_H
+#define COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_SERVER_H
+
+using Clock = std::chrono::steady_clock;
+
+// Queue shared by all connections, workers take requests from it in batches
+
+template<typename Request>
+class BatchQueue {
+ public:
+  void Push(Request&& request) {
+    {
+      std::lock_guard lock(mutex_);
+      requests_.push_back(std::move(request));
+    }
+    condition_.notify_one();
+  }
+
+  // Returns an empty batch only when the queue is closed and drained. A worker
+  // takes at most its share of the queue among the idle workers, so a burst is
+  // spread over the pool instead of being solved by one worker in turn.
+
+  std::vector<Request> PopBatch(size_t max_batch, std::chrono::microseconds window) {
+    std::unique_lock lock(mutex_);
+    ++idle_workers_;
+    condition_.wait(lock, [&] { return !requests_.empty() || closed_; });
+    if (requests_.size() < max_batch && !closed_) {
+      condition_.wait_until(lock, Clock::now() + window, [&] { return requests_.size() >= max_batch || closed_; });
+    }
+    size_t share = (requests_.size() + idle_workers_ - 1) / idle_workers_;
+    --idle_workers_;
+    std::vector<Request> batch;
+    while (!requests_.empty() && batch.size() < std::min(max_batch, share)) {
+      batch.push_back(std::move(requests_.front()));
+      requests_.pop_front();
+    }
+    if (!requests_.empty()) {
+      condition_.notify_one();
+    }
+    return batch;
+  }
+
+  void Close() {
+    {
+      std::lock_guard lock(mutex_);
+      closed_ = true;
+    }
+    condition_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<Request> requests_;
+  size_t idle_workers_ = 0;
+  bool closed_ = false;
+};
+
+// Latencies of the recent requests for percentiles, and completions per second
+// of the last kThroughputSeconds for throughput. Throughput is counted apart
+// from the latency samples, so it is not capped by their number.
+
+class LatencyStats {
+ public:
+  static constexpr size_t kSamples = 1 << 16;
+  static constexpr int64_t kThroughputSeconds = 10;
+
+  struct Snapshot {
+    size_t completed = 0;
+    size_t errors = 0;
+    double throughput_rps = 0;
+    double p50_us = 0;
+    double p90_us = 0;
+    double p99_us = 0;
+    double max_us = 0;
+  };
+
+  explicit LatencyStats(Clock::time_point started = Clock::now()) : started_(started) {}
+
+  void Record(Clock::time_point finished, double latency_us) {
+    std::lock_guard lock(mutex_);
+    ++completed_;
+    if (samples_.size() < kSamples) {
+      samples_.push_back(latency_us);
+    } else {
+      samples_[next_] = latency_us;
+    }
+    next_ = (next_ + 1) % kSamples;
+
+    int64_t second = SecondOf(finished);
+    PerSecond& bucket = per_second_[second % kThroughputSeconds];
+    if (bucket.second != second) {
+      bucket = PerSecond{second, 0};
+    }
+    ++bucket.completed;
+  }
+
+  void RecordError() {
+    std::lock_guard lock(mutex_);
+    ++errors_;
+  }
+
+  // Throughput covers the current second and the kThroughputSeconds - 1 before it
+
+  Snapshot Take(Clock::time_point now = Clock::now()) {
+    Snapshot snapshot;
+    std::vector<double> latencies;
+    int64_t now_second = SecondOf(now);
+    int64_t first_second = std::max<int64_t>(0, now_second - kThroughputSeconds + 1);
+    size_t recent = 0;
+    {
+      std::lock_guard lock(mutex_);
+      snapshot.completed = completed_;
+      snapshot.errors = errors_;
+      latencies = samples_;
+      for (const auto& bucket : per_second_) {
+        if (bucket.second >= first_second && bucket.second <= now_second) {
+          recent += bucket.completed;
+        }
+      }
+    }
+    double window = std::chrono::duration<double>(now - started_ - std::chrono::seconds(first_second)).count();
+    snapshot.throughput_rps = window > 0 ? recent / window : 0;
+    std::sort(latencies.begin(), latencies.end());
+    snapshot.p50_us = Percentile(latencies, 0.5);
+    snapshot.p90_us = Percentile(latencies, 0.9);
+    snapshot.p99_us = Percentile(latencies, 0.99);
+    snapshot.max_us = latencies.empty() ? 0 : latencies.back();
+    return snapshot;
+  }
+
+  std::string Report(Clock::time_point now = Clock::now()) {
+    Snapshot snapshot = Take(now);
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1)
+           << "stats completed=" << snapshot.completed << " errors=" << snapshot.errors
+           << " throughput_rps=" << snapshot.throughput_rps
+           << " p50_us=" << snapshot.p50_us << " p90_us=" << snapshot.p90_us
+           << " p99_us=" << snapshot.p99_us << " max_us=" << snapshot.max_us;
+    return report.str();
+  }
+
+ private:
+  struct PerSecond {
+    int64_t second = -1;
+    size_t completed = 0;
+  };
+
+  int64_t SecondOf(Clock::time_point time) const {
+    return std::max<int64_t>(0, std::chrono::duration_cast<std::chrono::seconds>(time - started_).count());
+  }
+
+  std::mutex mutex_;
+  std::vector<double> samples_;
+  size_t next_ = 0;
+  std::array<PerSecond, kThroughputSeconds> per_second_;
+  size_t completed_ = 0;
+  size_t errors_ = 0;
+  Clock::time_point started_;
+};
+
+#endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_SOLVER_SERVER_H
@@ -0,0 +1,276 @@
+#include <bitset>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "graph.h"
+
+
+#ifndef COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_ANTICLIQUE_ENUMERATOR_H
+#define COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_ANTICLIQUE_ENUMERATOR_H
+
+// Resumable and shardable enumeration of maximal anticliques.
+//
+// The search space is split by the lexicographic prefix of an anticlique: its
+// intersection P with the first L vertices. For a fixed independent prefix P
+// the anticliques are exactly P | T, where T is a maximal anticlique of the
+// subgraph induced on the vertices after the prefix not adjacent to P, which
+// also dominates the prefix vertices not dominated by P. Prefixes are dealt to
+// shards round-robin, so shards are disjoint and their union is the full list.
+//
+// The whole enumeration state is the current prefix position and the queue of
+// pending anticliques, which is what SaveCheckpoint writes to disk.
+
+template<size_t n>
+class MaxAnticliqueEnumerator {
+ public:
+  using VertexSet = VertexSubset<n>;
+
+  static constexpr size_t kPrefixesPerShard = 8;
+
+  MaxAnticliqueEnumerator(const Graph<n>& graph, size_t shard_index = 0, size_t shard_count = 1)
+    : graph_(graph), shard_index_(shard_index), shard_count_(shard_count) {
+    if (shard_count_ == 0 || shard_index_ >= shard_count_) {
+      throw std::invalid_argument("shard index is out of range");
+    }
+    BuildPrefixes();
+    prefix_position_ = shard_index_;
+    SeedPrefix();
+  }
+
+  // Returns the next maximal anticlique of the shard, or nullopt when the
+  // shard is exhausted or max_candidates candidates in a row were rejected,
+  // Finished() tells the two apart. The state is consistent after either
+  // return, so a long stretch of rejected candidates can be checkpointed.
+
+  std::optional<std::bitset<n>> Next(size_t max_candidates = std::numeric_limits<size_t>::max()) {
+    for (size_t candidates = 0; candidates < max_candidates;) {
+      if (queue_.empty()) {
+        if (prefix_position_ >= prefixes_.size()) {
+          return std::nullopt;
+        }
+        prefix_position_ += shard_count_;
+        SeedPrefix();
+        continue;
+      }
+      ++candidates;
+      VertexSet s = queue_.extract(queue_.begin()).value();
+      graph_.ExpandMaxAnticlique(s, allowed_, queue_);
+      if (Dominates(s.View())) {
+        ++emitted_;
+        return prefix_ | s.View();
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool Finished() const {
+    return queue_.empty() && prefix_position_ >= prefixes_.size();
+  }
+
+  size_t EmittedCount() const {
+    return emitted_;
+  }
+
+  size_t PrefixLength() const {
+    return prefix_length_;
+  }
+
+  // FNV-1a over the adjacency matrix, guards against resuming on another graph
+
+  uint64_t Fingerprint() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const auto& row : graph_.View()) {
+      for (size_t i = 0; i < n; ++i) {
+        hash = (hash ^ static_cast<uint64_t>(row[i])) * 0x100000001b3ull;
+      }
+    }
+    return hash;
+  }
+
+  void SaveCheckpoint(std::ostream& out) const {
+    WriteWord(out, kMagic);
+    WriteWord(out, n);
+    WriteWord(out, Fingerprint());
+    WriteWord(out, shard_index_);
+    WriteWord(out, shard_count_);
+    WriteWord(out, prefix_position_);
+    WriteWord(out, emitted_);
+    WriteWord(out, queue_.size());
+    for (const auto& s : queue_) {
+      WriteBits(out, s.View());
+    }
+    if (!out) {
+      throw std::runtime_error("failed to write checkpoint");
+    }
+  }
+
+  void LoadCheckpoint(std::istream& in) {
+    if (ReadWord(in) != kMagic || ReadWord(in) != n) {
+      throw std::runtime_error("not a checkpoint for this graph size");
+    }
+    if (ReadWord(in) != Fingerprint()) {
+      throw std::runtime_error("checkpoint was made for another graph");
+    }
+    if (ReadWord(in) != shard_index_ || ReadWord(in) != shard_count_) {
+      throw std::runtime_error("checkpoint was made for another shard");
+    }
+    uint64_t prefix_position = ReadWord(in);
+    uint64_t emitted = ReadWord(in);
+    uint64_t queue_size = ReadWord(in);
+    std::set<VertexSet> queue;
+    for (uint64_t i = 0; i < queue_size && in; ++i) {
+      queue.insert(VertexSet(ReadBits(in)));
+    }
+    bool finished = prefix_position == prefixes_.size() && queue.empty();
+    bool in_shard = prefix_position < prefixes_.size() && prefix_position % shard_count_ == shard_index_;
+    if (!in || !(finished || in_shard)) {
+      throw std::runtime_error("checkpoint is corrupted");
+    }
+    prefix_position_ = prefix_position;
+    emitted_ = emitted;
+    queue_ = std::move(queue);
+    if (prefix_position_ < prefixes_.size()) {
+      LoadPrefix();
+    }
+  }
+
+ private:
+  static constexpr uint64_t kMagic = 0x4b43334741434d58ull;
+
+  const Graph<n>& graph_;
+  size_t shard_index_;
+  size_t shard_count_;
+  size_t prefix_length_ = 0;
+  std::vector<std::bitset<n>> prefixes_;
+  size_t prefix_position_ = 0;
+  std::bitset<n> prefix_;
+  std::bitset<n> allowed_;
+  std::bitset<n> undominated_;
+  std::set<VertexSet> queue_;
+  uint64_t emitted_ = 0;
+
+  // Picks the shortest prefix length giving enough independent prefixes to
+  // balance the shards. A single shard uses the empty prefix and reproduces
+  // ListAllMaxAnticliques order exactly.
+
+  void BuildPrefixes() {
+    const auto& adjacency_matrix = graph_.View();
+    prefixes_.assign(1, std::bitset<n>());
+    while (shard_count_ > 1 && prefix_length_ < n && prefixes_.size() < kPrefixesPerShard * shard_count_) {
+      size_t v = prefix_length_++;
+      size_t size = prefixes_.size();
+      for (size_t i = 0; i < size; ++i) {
+        if ((prefixes_[i] & adjacency_matrix[v]).none()) {
+          std::bitset<n> extended = prefixes_[i];
+          extended.set(v);
+          prefixes_.push_back(std::move(extended));
+        }
+      }
+    }
+  }
+
+  // Moves to the first prefix from the current position that can be completed
+  // to a maximal anticlique and puts its first anticlique into the queue
+
+  void SeedPrefix() {
+    for (; prefix_position_ < prefixes_.size(); prefix_position_ += shard_count_) {
+      LoadPrefix();
+      if (CanDominate()) {
+        queue_.insert(VertexSet(graph_.LexMinMaxAnticlique(std::bitset<n>(), allowed_)));
+        return;
+      }
+    }
+    prefix_position_ = prefixes_.size();
+  }
+
+  void LoadPrefix() {
+    const auto& adjacency_matrix = graph_.View();
+    std::bitset<n> prefix_mask;
+    for (size_t i = 0; i < prefix_length_; ++i) {
+      prefix_mask.set(i);
+    }
+    prefix_ = prefixes_[prefix_position_];
+    std::bitset<n> covered = prefix_;
+    for (size_t i = 0; i < prefix_length_; ++i) {
+      if (prefix_[i]) {
+        covered |= adjacency_matrix[i];
+      }
+    }
+    allowed_ = ~(prefix_mask | covered);
+    undominated_ = prefix_mask & ~covered;
+  }
+
+  // Prefix vertices left undominated by the prefix must have a neighbour among
+  // the allowed vertices, otherwise no completion is maximal
+
+  bool CanDominate() const {
+    const auto& adjacency_matrix = graph_.View();
+    for (size_t i = 0; i < prefix_length_; ++i) {
+      if (undominated_[i] && (adjacency_matrix[i] & allowed_).none()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool Dominates(const std::bitset<n>& set_mask) const {
+    if (undominated_.none()) {
+      return true;
+    }
+    const auto& adjacency_matrix = graph_.View();
+    std::bitset<n> covered;
+    for (size_t i = prefix_length_; i < n; ++i) {
+      if (set_mask[i]) {
+        covered |= adjacency_matrix[i];
+      }
+    }
+    return (undominated_ & ~covered).none();
+  }
+
+  static void WriteWord(std::ostream& out, uint64_t value) {
+    unsigned char bytes[8];
+    for (size_t i = 0; i < 8; ++i) {
+      bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+    out.write(reinterpret_cast<const char*>(bytes), 8);
+  }
+
+  static uint64_t ReadWord(std::istream& in) {
+    unsigned char bytes[8] = {};
+    in.read(reinterpret_cast<char*>(bytes), 8);
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+      value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  static void WriteBits(std::ostream& out, const std::bitset<n>& bits) {
+    unsigned char bytes[(n + 7) / 8] = {};
+    for (size_t i = 0; i < n; ++i) {
+      if (bits[i]) {
+        bytes[i / 8] |= static_cast<unsigned char>(1u << (i % 8));
+      }
+    }
+    out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+  }
+
+  static std::bitset<n> ReadBits(std::istream& in) {
+    unsigned char bytes[(n + 7) / 8] = {};
+    in.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+    std::bitset<n> bits;
+    for (size_t i = 0; i < n; ++i) {
+      if (bytes[i / 8] & (1u << (i % 8))) {
+        bits.set(i);
+      }
+    }
+    return bits;
+  }
+};
+
+#endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_ANTICLIQUE_ENUMERATOR_H
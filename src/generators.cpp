@@ -0,0 +1,21 @@
+#include "generators.h"
+
+namespace {
+
+// SplitMix64 finalizer, decorrelates nearby seeds and stream numbers
+
+uint64_t Mix(uint64_t value) {
+  value += 0x9e3779b97f4a7c15ull;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+  return value ^ (value >> 31);
+}
+
+}  // namespace
+
+std::mt19937_64 MakeRandomStream(uint64_t seed, uint64_t stream) {
+  uint64_t key = Mix(Mix(seed) ^ stream);
+  std::seed_seq sequence{static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32),
+                         static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+  return std::mt19937_64(sequence);
+}
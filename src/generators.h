@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "graph.h"
+#include "graph_io.h"
+
+
+#ifndef COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GENERATORS_H
+#define COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GENERATORS_H
+
+// Independent random stream `stream` of the run with the given seed. Key the
+// stream on the work item rather than on the thread: the same (seed, stream)
+// pair always yields the same graphs, no matter how many threads share the work.
+
+std::mt19937_64 MakeRandomStream(uint64_t seed, uint64_t stream);
+
+// Below this density G(n, p) skips over absent edges, above it draws whole
+// words of edges at once
+
+constexpr double kSparseDensity = 0.03125;
+
+// Calls sink(i, j), i < j, for every edge of G(n, p) drawing one random number
+// per edge instead of one per pair: the gap to the next edge is geometric
+// (Batagelj, Brandes. Efficient generation of large random networks)
+
+template<typename EdgeSink>
+void SampleSparseEdges(size_t vertices, double p, std::mt19937_64& gen, EdgeSink&& sink) {
+  if (p <= 0 || vertices < 2) {
+    return;
+  }
+  if (p >= 1) {
+    for (size_t j = 1; j < vertices; ++j) {
+      for (size_t i = 0; i < j; ++i) {
+        sink(i, j);
+      }
+    }
+    return;
+  }
+  double log_q = std::log1p(-p);
+  double max_skip = static_cast<double>(vertices) * vertices;
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  size_t v = 1, w = 0;
+  bool first = true;
+  while (v < vertices) {
+    double skip = std::min(std::floor(std::log1p(-uniform(gen)) / log_q), max_skip);
+    w += static_cast<size_t>(skip) + (first ? 0 : 1);
+    first = false;
+    while (w >= v && v < vertices) {
+      w -= v;
+      ++v;
+    }
+    if (v < vertices) {
+      sink(w, v);
+    }
+  }
+}
+
+// 64 independent Bernoulli(p) bits per call. Processing the binary digits of p
+// from the lowest one, a digit 1 ORs and a digit 0 ANDs in a uniform word, so
+// p = 1/2 costs one word and any p at most 32 words; p is rounded down to a
+// multiple of 2^-32.
+
+class BernoulliWords {
+ public:
+  explicit BernoulliWords(double p)
+    : threshold_(p >= 1 ? kOne : static_cast<uint64_t>(std::max(p, 0.0) * kOne)) {}
+
+  uint64_t operator()(std::mt19937_64& gen) const {
+    if (threshold_ == 0) {
+      return 0;
+    }
+    if (threshold_ >= kOne) {
+      return ~0ull;
+    }
+    uint64_t word = 0;
+    for (int digit = std::countr_zero(threshold_); digit < 32; ++digit) {
+      if ((threshold_ >> digit) & 1) {
+        word |= gen();
+      } else {
+        word &= gen();
+      }
+    }
+    return word;
+  }
+
+ private:
+  static constexpr uint64_t kOne = 1ull << 32;
+
+  uint64_t threshold_;
+};
+
+// Fills adjacency rows of G(n, p) word by word: the upper part of row i is
+// drawn 64 columns at a time and mirrored into the rows of its neighbours
+
+template<size_t n>
+void FillDenseRows(std::vector<std::bitset<n>>& adj_matrix, double p, std::mt19937_64& gen) {
+  BernoulliWords bernoulli(p);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    for (size_t offset = i + 1; offset < n; offset += 64) {
+      uint64_t word = bernoulli(gen);
+      if (n - offset < 64) {
+        word &= (1ull << (n - offset)) - 1;
+      }
+      adj_matrix[i] |= std::bitset<n>(word) << offset;
+      for (; word != 0; word &= word - 1) {
+        adj_matrix[offset + std::countr_zero(word)].set(i);
+      }
+    }
+  }
+}
+
+// Generates random graph G(n, p) from Erdos-Renyi model
+
+template<size_t n>
+Graph<n> GenerateRandomGraph(double p, std::mt19937_64& gen) {
+  std::vector<std::bitset<n>> adj_matrix(n);
+  if (p < kSparseDensity) {
+    SampleSparseEdges(n, p, gen, [&](size_t i, size_t j) {
+      adj_matrix[i].set(j);
+      adj_matrix[j].set(i);
+    });
+  } else {
+    FillDenseRows(adj_matrix, p, gen);
+  }
+  return Graph<n>(std::move(adj_matrix));
+}
+
+inline EdgeList GenerateRandomEdgeList(size_t vertices, double p, std::mt19937_64& gen) {
+  EdgeList graph;
+  graph.vertices = vertices;
+  SampleSparseEdges(vertices, p, gen, [&](size_t i, size_t j) {
+    graph.edges.push_back({i, j});
+  });
+  return graph;
+}
+
+// Makes vertices [first, first + size) a clique
+
+template<size_t n>
+void AddClique(std::vector<std::bitset<n>>& adj_matrix, size_t first, size_t size) {
+  std::bitset<n> block;
+  for (size_t v = first; v < first + size; ++v) {
+    block.set(v);
+  }
+  for (size_t v = first; v < first + size; ++v) {
+    adj_matrix[v] |= block;
+    adj_matrix[v].reset(v);
+  }
+}
+
+// Generates graph with the greatest number of maximal anticliques (Moon, Moser):
+// disjoint triangles, with K4 or K2 taking the remainder
+
+template<size_t n>
+Graph<n> GenerateMaxGraph() {
+  std::vector<std::bitset<n>> adj_matrix(n);
+  size_t first = 0;
+  if (n % 3 == 1 && n > 3) {
+    AddClique(adj_matrix, 0, 4);
+    first = 4;
+  }
+  if (n % 3 == 2) {
+    AddClique(adj_matrix, 0, 2);
+    first = 2;
+  }
+  for (; first + 3 <= n; first += 3) {
+    AddClique(adj_matrix, first, 3);
+  }
+  return Graph<n>(std::move(adj_matrix));
+}
+
+template<size_t n>
+Graph<n> GenerateCompleteGraph() {
+  std::vector<std::bitset<n>> adj_matrix(n);
+  AddClique(adj_matrix, 0, n);
+  return Graph<n>(std::move(adj_matrix));
+}
+
+template<size_t n>
+Graph<n> GenerateCycleGraph() {
+  std::vector<std::bitset<n>> adj_matrix(n);
+  for (size_t v = 0; n > 2 && v < n; ++v) {
+    adj_matrix[v].set((v + 1) % n);
+    adj_matrix[(v + 1) % n].set(v);
+  }
+  return Graph<n>(std::move(adj_matrix));
+}
+
+#endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GENERATORS_H
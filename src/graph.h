@@ -110,7 +110,13 @@ class Graph {
   }
 
   std::bitset<n> LexMinMaxAnticlique(const std::bitset<n> &condition) const {
-    std::bitset<n> access;
+    return LexMinMaxAnticlique(condition, std::bitset<n>().set());
+  }
+
+  // Same as above, but restricted to the induced subgraph on `allowed` vertices
+
+  std::bitset<n> LexMinMaxAnticlique(const std::bitset<n> &condition, const std::bitset<n> &allowed) const {
+    std::bitset<n> access = ~allowed;
     for (size_t i = 0; i < n; ++i) {
       if (condition[i]) {
         access |= adjacency_matrix_[i];
@@ -128,6 +134,8 @@ class Graph {
   std::vector<std::bitset<n>> ListAllMaxAnticliques() const {
     std::vector<std::bitset<n>> answer;
     std::set<VertexSet> queue;
+    std::bitset<n> allowed;
+    allowed.set();
 
     VertexSet first = VertexSet(LexMinMaxAnticlique());
     queue.insert(first);
@@ -135,25 +143,32 @@ class Graph {
     while (!queue.empty()) {
       auto it = queue.begin();
       VertexSet s = queue.extract(it).value();
-      for (size_t j = s.MinVertex() + 1; j < n; ++j) {
-        if (CheckMaxAnticliqueOnPrefixConstraint(s, j)) {
-          std::bitset<n> set_mask = s.View();
-          set_mask >>= (n - j - 1);
-          set_mask <<= (n - j - 1);
-          set_mask &= (~adjacency_matrix_[j]);
-          set_mask.set(j);
-          std::bitset<n> new_set_mask = LexMinMaxAnticlique(set_mask);
-          VertexSet t(std::move(new_set_mask));
-          if (s < t) {
-            queue.insert(std::move(t));
-          }
-        }
-      }
+      ExpandMaxAnticlique(s, allowed, queue);
       answer.push_back(std::move(s.Extract()));
     }
     return answer;
   }
 
+  // Pushes into the queue all lexicographically greater maximal anticliques of
+  // the induced subgraph on `allowed` vertices that are generated from `s`
+
+  void ExpandMaxAnticlique(const VertexSet& s, const std::bitset<n>& allowed, std::set<VertexSet>& queue) const {
+    for (size_t j = s.MinVertex() + 1; j < n; ++j) {
+      if (allowed[j] && CheckMaxAnticliqueOnPrefixConstraint(s, j, allowed)) {
+        std::bitset<n> set_mask = s.View();
+        set_mask <<= (n - j);
+        set_mask >>= (n - j);
+        set_mask &= (~adjacency_matrix_[j]);
+        set_mask.set(j);
+        std::bitset<n> new_set_mask = LexMinMaxAnticlique(set_mask, allowed);
+        VertexSet t(std::move(new_set_mask));
+        if (s < t) {
+          queue.insert(std::move(t));
+        }
+      }
+    }
+  }
+
   bool Check3Coloring() const {
     std::vector<std::bitset<n>> max_anticliques = ListAllMaxAnticliques();
     for (const auto& max_anticlique : max_anticliques) {
@@ -184,26 +199,6 @@ class Graph {
     return edges;
   }
 
- private:
-  std::vector<std::bitset<n>> adjacency_matrix_;
-
-  bool CheckMaxAnticliqueOnPrefixConstraint(const VertexSet& vertex_set, size_t j) const {
-    std::bitset<n> set_mask = vertex_set.View();
-    std::bitset<n> covering_mask;
-    for (size_t i = 0; i <= j; ++i) {
-      if ((set_mask[i] && !adjacency_matrix_[j][i]) || i == j) {
-        covering_mask.set(i);
-        covering_mask |= adjacency_matrix_[i];
-      }
-    }
-    for (size_t i = 0; i <= j; ++i) {
-      if (!covering_mask[i]) {
-        return false;
-      }
-    }
-    return true;
-  }
-
   bool CheckRestIsBipartite(const std::bitset<n> set_mask) const {
     std::vector<char> color(n, -1);
     std::stack<std::pair<size_t, size_t>> st;
@@ -238,6 +233,26 @@ class Graph {
     }
     return true;
   }
+
+ private:
+  std::vector<std::bitset<n>> adjacency_matrix_;
+
+  bool CheckMaxAnticliqueOnPrefixConstraint(const VertexSet& vertex_set, size_t j, const std::bitset<n>& allowed) const {
+    std::bitset<n> set_mask = vertex_set.View();
+    std::bitset<n> covering_mask = ~allowed;
+    for (size_t i = 0; i <= j; ++i) {
+      if ((set_mask[i] && !adjacency_matrix_[j][i]) || i == j) {
+        covering_mask.set(i);
+        covering_mask |= adjacency_matrix_[i];
+      }
+    }
+    for (size_t i = 0; i <= j; ++i) {
+      if (!covering_mask[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
 };
 
 #endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GRAPH_H
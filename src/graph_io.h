@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <bitset>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+
+
+#ifndef COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GRAPH_IO_H
+#define COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GRAPH_IO_H
+
+// Graph with the number of vertices known only at runtime, vertices are
+// numbered from 0
+
+struct EdgeList {
+  size_t vertices = 0;
+  std::vector<std::pair<size_t, size_t>> edges;
+};
+
+constexpr size_t kMaxPaddedVertices = 128;
+
+// Reads "n m" followed by m pairs "u v" with vertices numbered from 1. The
+// header is checked before anything is allocated, so a hostile one costs
+// nothing.
+
+inline EdgeList ReadEdgeList(std::istream& input, size_t max_vertices = kMaxPaddedVertices) {
+  EdgeList graph;
+  size_t edge_count = 0;
+  if (!(input >> graph.vertices >> edge_count)) {
+    throw std::invalid_argument("expected number of vertices and edges");
+  }
+  if (graph.vertices > max_vertices) {
+    throw std::invalid_argument("graphs with more than " + std::to_string(max_vertices) +
+                                " vertices are not supported");
+  }
+  if (graph.vertices < 2 ? edge_count > 0 : edge_count > graph.vertices * (graph.vertices - 1) / 2) {
+    throw std::invalid_argument("too many edges");
+  }
+  for (size_t i = 0; i < edge_count; ++i) {
+    std::pair<size_t, size_t> edge;
+    if (!(input >> edge.first >> edge.second)) {
+      throw std::invalid_argument("expected an edge");
+    }
+    if (edge.first == 0 || edge.second == 0 || edge.first > graph.vertices || edge.second > graph.vertices) {
+      throw std::invalid_argument("vertex is out of range");
+    }
+    // The graph algorithms assume the diagonal of the adjacency matrix is clear
+    if (edge.first == edge.second) {
+      throw std::invalid_argument("self-loops are not supported");
+    }
+    graph.edges.push_back({edge.first - 1, edge.second - 1});
+  }
+  return graph;
+}
+
+// Parses graph6 format (https://users.cecs.anu.edu.au/~bdm/data/formats.txt)
+
+inline EdgeList ParseGraph6(const std::string& text, size_t max_vertices = kMaxPaddedVertices) {
+  static const std::string kHeader = ">>graph6<<";
+  size_t position = text.compare(0, kHeader.size(), kHeader) == 0 ? kHeader.size() : 0;
+  auto next = [&]() -> size_t {
+    if (position >= text.size() || text[position] < 63 || text[position] > 126) {
+      throw std::invalid_argument("malformed graph6 string");
+    }
+    return static_cast<size_t>(text[position++] - 63);
+  };
+
+  EdgeList graph;
+  graph.vertices = next();
+  if (graph.vertices == 63) {
+    graph.vertices = 0;
+    for (size_t i = 0; i < 3; ++i) {
+      graph.vertices = (graph.vertices << 6) | next();
+    }
+  }
+  if (graph.vertices > max_vertices) {
+    throw std::invalid_argument("graphs with more than " + std::to_string(max_vertices) +
+                                " vertices are not supported");
+  }
+  size_t bits = 0, bit_count = 0;
+  for (size_t j = 1; j < graph.vertices; ++j) {
+    for (size_t i = 0; i < j; ++i) {
+      if (bit_count == 0) {
+        bits = next();
+        bit_count = 6;
+      }
+      --bit_count;
+      if ((bits >> bit_count) & 1) {
+        graph.edges.push_back({i, j});
+      }
+    }
+  }
+  if (position != text.size()) {
+    throw std::invalid_argument("trailing characters after graph6 string");
+  }
+  return graph;
+}
+
+inline std::string FormatGraph6(const EdgeList& graph) {
+  std::string text;
+  if (graph.vertices < 63) {
+    text.push_back(static_cast<char>(graph.vertices + 63));
+  } else {
+    text.push_back(126);
+    for (size_t i = 0; i < 3; ++i) {
+      text.push_back(static_cast<char>(((graph.vertices >> (6 * (2 - i))) & 63) + 63));
+    }
+  }
+  std::vector<bool> upper(graph.vertices * (graph.vertices - (graph.vertices > 0)) / 2);
+  for (const auto& [u, v] : graph.edges) {
+    size_t i = std::min(u, v), j = std::max(u, v);
+    upper[j * (j - 1) / 2 + i] = true;
+  }
+  for (size_t k = 0; k < upper.size(); k += 6) {
+    size_t bits = 0;
+    for (size_t b = 0; b < 6; ++b) {
+      bits = (bits << 1) | (k + b < upper.size() && upper[k + b]);
+    }
+    text.push_back(static_cast<char>(bits + 63));
+  }
+  return text;
+}
+
+// Graph<n> is sized at compile time, smaller graphs are padded with isolated
+// vertices. They belong to every maximal anticlique, so neither the number of
+// maximal anticliques nor 3-colorability changes.
+
+template<size_t n>
+Graph<n> BuildPaddedGraph(const EdgeList& graph) {
+  std::vector<std::bitset<n>> adj_matrix(n);
+  for (const auto& edge : graph.edges) {
+    adj_matrix[edge.first].set(edge.second);
+    adj_matrix[edge.second].set(edge.first);
+  }
+  return Graph<n>(std::move(adj_matrix));
+}
+
+// Calls visitor with the graph padded to the nearest supported size
+
+template<typename Visitor>
+auto VisitPaddedGraph(const EdgeList& graph, Visitor&& visitor) {
+  if (graph.vertices <= 16) {
+    return visitor(BuildPaddedGraph<16>(graph));
+  }
+  if (graph.vertices <= 32) {
+    return visitor(BuildPaddedGraph<32>(graph));
+  }
+  if (graph.vertices <= 48) {
+    return visitor(BuildPaddedGraph<48>(graph));
+  }
+  if (graph.vertices <= 64) {
+    return visitor(BuildPaddedGraph<64>(graph));
+  }
+  if (graph.vertices <= 80) {
+    return visitor(BuildPaddedGraph<80>(graph));
+  }
+  if (graph.vertices <= kMaxPaddedVertices) {
+    return visitor(BuildPaddedGraph<kMaxPaddedVertices>(graph));
+  }
+  throw std::invalid_argument("graphs with more than 128 vertices are not supported");
+}
+
+#endif //COMPUTATIONAL_COMPLEXITY_GRAPH3COLORING_GRAPH_IO_H
@@ -1,5 +1,15 @@
 #include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include "graph.h"
+#include "anticlique_enumerator.h"
+#include "graph_io.h"
+#include "generators.h"
+#include "solver_protocol.h"
+#include "solver_server.h"
 
 template <size_t n>
 Graph<n> BuildGraph(std::vector<std::pair<size_t, size_t>> edges) {
@@ -241,6 +251,440 @@ TEST(Check3Coloring, NamedGraphs) {
   EXPECT_TRUE(petersen_graph.Check3Coloring());
 }
 
+template <size_t n>
+std::vector<std::bitset<n>> ListShard(const Graph<n>& graph, size_t shard_index, size_t shard_count) {
+  std::vector<std::bitset<n>> answer;
+  MaxAnticliqueEnumerator<n> enumerator(graph, shard_index, shard_count);
+  while (auto anticlique = enumerator.Next()) {
+    answer.push_back(*anticlique);
+  }
+  return answer;
+}
+
+template <size_t n>
+std::vector<std::bitset<n>> SortedAsVertexSets(std::vector<std::bitset<n>> anticliques) {
+  std::sort(anticliques.begin(), anticliques.end(), [](const auto& lhs, const auto& rhs) {
+    return VertexSubset<n>(lhs) < VertexSubset<n>(rhs);
+  });
+  return anticliques;
+}
+
+TEST(ListAllMaxAnticliques, BruteForce) {
+  // Every graph on 6 vertices with edges taken by the bits of the mask
+  constexpr size_t n = 6;
+  std::vector<std::pair<size_t, size_t>> pairs;
+  for (size_t i = 1; i <= n; ++i) {
+    for (size_t j = i + 1; j <= n; ++j) {
+      pairs.push_back({i, j});
+    }
+  }
+  for (size_t mask = 0; mask < (1u << pairs.size()); mask += 37) {
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t k = 0; k < pairs.size(); ++k) {
+      if (mask >> k & 1) {
+        edges.push_back(pairs[k]);
+      }
+    }
+    Graph<n> graph = BuildGraph<n>(edges);
+    std::vector<std::bitset<n>> expected;
+    for (size_t subset = 0; subset < (1u << n); ++subset) {
+      std::bitset<n> set_mask(subset), covered(subset);
+      bool independent = true;
+      for (size_t v = 0; v < n; ++v) {
+        if (set_mask[v]) {
+          independent = independent && (graph.View()[v] & set_mask).none();
+          covered |= graph.View()[v];
+        }
+      }
+      if (independent && covered.all()) {
+        expected.push_back(set_mask);
+      }
+    }
+    EXPECT_EQ(graph.ListAllMaxAnticliques(), SortedAsVertexSets(expected)) << "mask " << mask;
+  }
+}
+
+TEST(MaxAnticliqueEnumerator, SingleShardMatchesListAll) {
+  Graph<10> petersen_graph = BuildGraph<10>({
+    {1, 2}, {1, 3}, {1, 4}, {2, 5}, {2, 9},
+    {3, 7}, {3, 8}, {4, 6}, {4, 10}, {5, 6},
+    {5, 8}, {6, 7}, {7, 9}, {8, 10}, {9, 10}
+  });
+
+  EXPECT_EQ(ListShard(petersen_graph, 0, 1), petersen_graph.ListAllMaxAnticliques());
+}
+
+TEST(MaxAnticliqueEnumerator, ShardsPartitionAnticliques) {
+  Graph<10> petersen_graph = BuildGraph<10>({
+    {1, 2}, {1, 3}, {1, 4}, {2, 5}, {2, 9},
+    {3, 7}, {3, 8}, {4, 6}, {4, 10}, {5, 6},
+    {5, 8}, {6, 7}, {7, 9}, {8, 10}, {9, 10}
+  });
+  Graph<9> triangles = BuildGraph<9>({{1, 2}, {1, 3}, {2, 3}, {4, 5}, {4, 6},
+                                      {5, 6}, {7, 8}, {7, 9}, {8, 9}});
+
+  for (size_t shard_count : {2, 3, 5, 16}) {
+    std::vector<std::bitset<10>> petersen_merged;
+    std::vector<std::bitset<9>> triangles_merged;
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+      auto petersen_shard = ListShard(petersen_graph, shard, shard_count);
+      auto triangles_shard = ListShard(triangles, shard, shard_count);
+      petersen_merged.insert(petersen_merged.end(), petersen_shard.begin(), petersen_shard.end());
+      triangles_merged.insert(triangles_merged.end(), triangles_shard.begin(), triangles_shard.end());
+    }
+    EXPECT_EQ(SortedAsVertexSets(petersen_merged), petersen_graph.ListAllMaxAnticliques());
+    EXPECT_EQ(SortedAsVertexSets(triangles_merged), triangles.ListAllMaxAnticliques());
+    EXPECT_EQ(triangles_merged.size(), 27);
+  }
+}
+
+TEST(MaxAnticliqueEnumerator, ResumesFromCheckpoint) {
+  Graph<9> triangles = BuildGraph<9>({{1, 2}, {1, 3}, {2, 3}, {4, 5}, {4, 6},
+                                      {5, 6}, {7, 8}, {7, 9}, {8, 9}});
+
+  for (size_t shard_count : {1, 3}) {
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+      auto expected = ListShard(triangles, shard, shard_count);
+      for (size_t stop = 0; stop <= expected.size(); ++stop) {
+        std::vector<std::bitset<9>> resumed;
+        std::stringstream checkpoint;
+        {
+          MaxAnticliqueEnumerator<9> enumerator(triangles, shard, shard_count);
+          for (size_t i = 0; i < stop; ++i) {
+            resumed.push_back(*enumerator.Next());
+          }
+          enumerator.SaveCheckpoint(checkpoint);
+        }
+        MaxAnticliqueEnumerator<9> enumerator(triangles, shard, shard_count);
+        enumerator.LoadCheckpoint(checkpoint);
+        EXPECT_EQ(enumerator.EmittedCount(), stop);
+        while (auto anticlique = enumerator.Next()) {
+          resumed.push_back(*anticlique);
+        }
+        EXPECT_EQ(resumed, expected);
+      }
+    }
+  }
+}
+
+TEST(MaxAnticliqueEnumerator, CheckpointsBetweenRejectedCandidates) {
+  Graph<10> petersen_graph = BuildGraph<10>({
+    {1, 2}, {1, 3}, {1, 4}, {2, 5}, {2, 9},
+    {3, 7}, {3, 8}, {4, 6}, {4, 10}, {5, 6},
+    {5, 8}, {6, 7}, {7, 9}, {8, 10}, {9, 10}
+  });
+
+  size_t interruptions = 0;
+  for (size_t shard_count : {1, 3}) {
+    for (size_t shard = 0; shard < shard_count; ++shard) {
+      std::vector<std::bitset<10>> listed;
+      auto enumerator = std::make_unique<MaxAnticliqueEnumerator<10>>(petersen_graph, shard, shard_count);
+      while (true) {
+        auto anticlique = enumerator->Next(1);
+        if (anticlique) {
+          listed.push_back(*anticlique);
+          continue;
+        }
+        if (enumerator->Finished()) {
+          break;
+        }
+        ++interruptions;
+        std::stringstream checkpoint;
+        enumerator->SaveCheckpoint(checkpoint);
+        enumerator = std::make_unique<MaxAnticliqueEnumerator<10>>(petersen_graph, shard, shard_count);
+        enumerator->LoadCheckpoint(checkpoint);
+      }
+      EXPECT_EQ(listed, ListShard(petersen_graph, shard, shard_count));
+    }
+  }
+  EXPECT_GT(interruptions, 0);
+}
+
+TEST(MaxAnticliqueEnumerator, RejectsForeignCheckpoint) {
+  Graph<5> gr1 = BuildGraph<5>({{1, 2}});
+  Graph<5> gr2 = BuildGraph<5>({{1, 3}});
+
+  std::stringstream checkpoint;
+  MaxAnticliqueEnumerator<5>(gr1).SaveCheckpoint(checkpoint);
+  MaxAnticliqueEnumerator<5> enumerator(gr2);
+  EXPECT_THROW(enumerator.LoadCheckpoint(checkpoint), std::runtime_error);
+}
+
+TEST(GraphIO, Graph6) {
+  // K4, path on 5 vertices and the empty graph on 70 vertices
+  EdgeList full = ParseGraph6("C~");
+  EdgeList path = ParseGraph6(">>graph6<<DhC");
+  EdgeList empty = ParseGraph6(FormatGraph6(EdgeList{70, {}}));
+
+  EXPECT_EQ(full.vertices, 4);
+  EXPECT_EQ(full.edges.size(), 6);
+  EXPECT_EQ(path.vertices, 5);
+  EXPECT_EQ(path.edges, (std::vector<std::pair<size_t, size_t>>{{0, 1}, {1, 2}, {2, 3}, {3, 4}}));
+  EXPECT_EQ(empty.vertices, 70);
+  EXPECT_TRUE(empty.edges.empty());
+  EXPECT_EQ(FormatGraph6(full), "C~");
+  EXPECT_EQ(FormatGraph6(path), "DhC");
+  EXPECT_THROW(ParseGraph6("C~~"), std::invalid_argument);
+  EXPECT_THROW(ParseGraph6("C"), std::invalid_argument);
+}
+
+TEST(GraphIO, PaddedGraphKeepsAnswers) {
+  // Petersen graph
+  std::istringstream input("10 15 1 2 1 3 1 4 2 5 2 9 3 7 3 8 4 6 4 10 5 6 5 8 6 7 7 9 8 10 9 10");
+  EdgeList petersen = ReadEdgeList(input);
+
+  EXPECT_EQ(VisitPaddedGraph(petersen, [](const auto& graph) { return graph.ListAllMaxAnticliques().size(); }),
+            BuildGraph<10>({{1, 2}, {1, 3}, {1, 4}, {2, 5}, {2, 9}, {3, 7}, {3, 8}, {4, 6},
+                            {4, 10}, {5, 6}, {5, 8}, {6, 7}, {7, 9}, {8, 10}, {9, 10}}).ListAllMaxAnticliques().size());
+  EXPECT_TRUE(VisitPaddedGraph(petersen, [](const auto& graph) { return graph.Check3Coloring(); }));
+  EXPECT_FALSE(VisitPaddedGraph(ParseGraph6("C~"), [](const auto& graph) { return graph.Check3Coloring(); }));
+
+  std::istringstream out_of_range("3 1 1 4");
+  EXPECT_THROW(ReadEdgeList(out_of_range), std::invalid_argument);
+  std::istringstream self_loop("3 1 1 1");
+  EXPECT_THROW(ReadEdgeList(self_loop), std::invalid_argument);
+  std::istringstream too_many_vertices("60000 300000000 1 2");
+  EXPECT_THROW(ReadEdgeList(too_many_vertices), std::invalid_argument);
+  std::istringstream too_many_edges("4 7 1 2");
+  EXPECT_THROW(ReadEdgeList(too_many_edges), std::invalid_argument);
+  std::istringstream full("4 6 1 2 1 3 1 4 2 3 2 4 3 4");
+  EXPECT_EQ(ReadEdgeList(full).edges.size(), 6);
+  EXPECT_THROW(ParseGraph6(FormatGraph6(EdgeList{200, {}})), std::invalid_argument);
+}
+
+template <size_t n>
+void ExpectSimpleGraph(const Graph<n>& graph) {
+  for (size_t i = 0; i < n; ++i) {
+    EXPECT_FALSE(graph.View()[i][i]);
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_EQ(graph.View()[i][j], graph.View()[j][i]);
+    }
+  }
+}
+
+TEST(Generators, RandomGraphDensity) {
+  // 4950 pairs per graph, 20 graphs, the edge share is within a few standard deviations of p
+  for (double p : {0.01, 0.03125, 0.1, 0.25, 0.5, 0.7}) {
+    std::mt19937_64 gen = MakeRandomStream(1, 0);
+    size_t edges = 0;
+    for (size_t i = 0; i < 20; ++i) {
+      Graph<100> graph = GenerateRandomGraph<100>(p, gen);
+      ExpectSimpleGraph(graph);
+      edges += graph.EdgeCount();
+    }
+    double pairs = 20 * 4950;
+    EXPECT_NEAR(edges / pairs, p, 5 * std::sqrt(p * (1 - p) / pairs) + 1e-9) << "p = " << p;
+  }
+
+  std::mt19937_64 gen = MakeRandomStream(1, 0);
+  EXPECT_EQ(GenerateRandomGraph<70>(0.0, gen).EdgeCount(), 0);
+  EXPECT_EQ(GenerateRandomGraph<70>(1.0, gen).EdgeCount(), 70 * 69 / 2);
+  EXPECT_EQ(GenerateRandomEdgeList(70, 1.0, gen).edges.size(), 70 * 69 / 2);
+}
+
+TEST(Generators, RandomStreamsAreReproducible) {
+  std::mt19937_64 gen1 = MakeRandomStream(7, 3);
+  std::mt19937_64 gen2 = MakeRandomStream(7, 3);
+  std::mt19937_64 gen3 = MakeRandomStream(7, 4);
+
+  Graph<40> graph1 = GenerateRandomGraph<40>(0.5, gen1);
+  Graph<40> graph2 = GenerateRandomGraph<40>(0.5, gen2);
+  Graph<40> graph3 = GenerateRandomGraph<40>(0.5, gen3);
+  EXPECT_EQ(graph1.View(), graph2.View());
+  EXPECT_NE(graph1.View(), graph3.View());
+}
+
+TEST(Generators, StructuredGraphs) {
+  // Moon-Moser bound: 3^(n/3), 4 * 3^((n - 4)/3) and 2 * 3^((n - 2)/3) maximal anticliques
+  EXPECT_EQ(GenerateMaxGraph<9>().ListAllMaxAnticliques().size(), 27);
+  EXPECT_EQ(GenerateMaxGraph<10>().ListAllMaxAnticliques().size(), 36);
+  EXPECT_EQ(GenerateMaxGraph<11>().ListAllMaxAnticliques().size(), 54);
+  EXPECT_EQ(GenerateMaxGraph<10>().EdgeCount(), 6 + 2 * 3);
+  ExpectSimpleGraph(GenerateMaxGraph<11>());
+
+  EXPECT_EQ(GenerateCompleteGraph<5>().View(), BuildFullGraph<5>().View());
+  EXPECT_EQ(GenerateCycleGraph<5>().View(), BuildGraph<5>({{1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 1}}).View());
+  EXPECT_TRUE(GenerateCycleGraph<7>().Check3Coloring());
+  EXPECT_FALSE(GenerateCompleteGraph<4>().Check3Coloring());
+}
+
+TEST(SolverServer, Percentile) {
+  std::vector<double> values{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+
+  EXPECT_EQ(Percentile({}, 0.5), 0);
+  EXPECT_EQ(Percentile(values, 0), 1);
+  EXPECT_EQ(Percentile(values, 0.5), 5);
+  EXPECT_EQ(Percentile(values, 0.9), 9);
+  EXPECT_EQ(Percentile(values, 0.99), 10);
+  EXPECT_EQ(Percentile(values, 1), 10);
+}
+
+TEST(SolverServer, LatencyStats) {
+  Clock::time_point started = Clock::now();
+  LatencyStats stats(started);
+  for (size_t i = 1; i <= 100; ++i) {
+    stats.Record(started, static_cast<double>(i));
+  }
+  stats.RecordError();
+
+  LatencyStats::Snapshot snapshot = stats.Take(started + std::chrono::seconds(1));
+  EXPECT_EQ(snapshot.completed, 100);
+  EXPECT_EQ(snapshot.errors, 1);
+  EXPECT_DOUBLE_EQ(snapshot.throughput_rps, 100);
+  EXPECT_EQ(snapshot.p50_us, 50);
+  EXPECT_EQ(snapshot.p90_us, 90);
+  EXPECT_EQ(snapshot.p99_us, 99);
+  EXPECT_EQ(snapshot.max_us, 100);
+}
+
+TEST(SolverServer, LatencyStatsThroughputIsNotCappedBySamples) {
+  Clock::time_point started = Clock::now();
+  LatencyStats stats(started);
+
+  // 20000 requests per second for 5 seconds, more than the latency samples kept
+  for (size_t i = 0; i < 100000; ++i) {
+    stats.Record(started + std::chrono::microseconds(i * 50), 10);
+  }
+
+  LatencyStats::Snapshot snapshot = stats.Take(started + std::chrono::seconds(5));
+  EXPECT_EQ(snapshot.completed, 100000);
+  EXPECT_DOUBLE_EQ(snapshot.throughput_rps, 20000);
+  EXPECT_EQ(snapshot.max_us, 10);
+
+  // Only the last seconds count towards throughput
+  snapshot = stats.Take(started + std::chrono::seconds(13));
+  EXPECT_DOUBLE_EQ(snapshot.throughput_rps, 20000.0 / 9);
+  snapshot = stats.Take(started + std::chrono::seconds(30));
+  EXPECT_EQ(snapshot.completed, 100000);
+  EXPECT_EQ(snapshot.throughput_rps, 0);
+}
+
+TEST(SolverServer, BatchQueue) {
+  BatchQueue<int> queue;
+  for (int i = 0; i < 5; ++i) {
+    queue.Push(std::move(i));
+  }
+
+  EXPECT_EQ(queue.PopBatch(3, std::chrono::microseconds(0)), (std::vector<int>{0, 1, 2}));
+  EXPECT_EQ(queue.PopBatch(3, std::chrono::microseconds(0)), (std::vector<int>{3, 4}));
+
+  // A worker waits for the batch to fill within the window
+  std::thread producer([&] {
+    queue.Push(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Push(6);
+  });
+  EXPECT_EQ(queue.PopBatch(2, std::chrono::seconds(10)), (std::vector<int>{5, 6}));
+  producer.join();
+
+  // Closing wakes up waiting workers and drains the rest
+  queue.Push(7);
+  std::thread closer([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.Close();
+  });
+  EXPECT_EQ(queue.PopBatch(2, std::chrono::seconds(10)), (std::vector<int>{7}));
+  EXPECT_TRUE(queue.PopBatch(2, std::chrono::seconds(10)).empty());
+  closer.join();
+}
+
+TEST(SolverServer, BatchQueueSplitsBurstBetweenWorkers) {
+  BatchQueue<int> queue;
+  std::vector<int> first, second;
+  std::thread first_worker([&] { first = queue.PopBatch(16, std::chrono::microseconds(0)); });
+  std::thread second_worker([&] { second = queue.PopBatch(16, std::chrono::microseconds(0)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  for (int i = 0; i < 8; ++i) {
+    queue.Push(std::move(i));
+  }
+  first_worker.join();
+  second_worker.join();
+
+  EXPECT_FALSE(first.empty());
+  EXPECT_FALSE(second.empty());
+  EXPECT_LE(first.size() + second.size(), 8);
+}
+
+#ifdef SHARDED_ENUMERATION_BINARY
+
+// Runs run_sharded_enumeration and returns what it prints, optionally under a
+// limit on open files
+
+std::string RunShardedEnumeration(const std::string& arguments, size_t max_open_files = 0) {
+  std::string output;
+  std::string command = std::string(SHARDED_ENUMERATION_BINARY) + " " + arguments + " 2>&1";
+  if (max_open_files > 0) {
+    command = "ulimit -n " + std::to_string(max_open_files) + " && " + command;
+  }
+  FILE* pipe = popen(command.c_str(), "r");
+  char buffer[256];
+  while (fgets(buffer, sizeof(buffer), pipe)) {
+    output += buffer;
+  }
+  pclose(pipe);
+  return output;
+}
+
+TEST(ShardedEnumeration, ReusedWorkDirectory) {
+  std::filesystem::path work_dir = std::filesystem::temp_directory_path() / "graph3coloring_reused_work_dir";
+  std::filesystem::remove_all(work_dir);
+  std::filesystem::create_directories(work_dir);
+  std::filesystem::path triangles = work_dir / "triangles.txt";
+  std::filesystem::path full = work_dir / "full.txt";
+  std::ofstream(triangles) << "9 9 1 2 1 3 2 3 4 5 4 6 5 6 7 8 7 9 8 9\n";
+  std::ofstream(full) << "4 6 1 2 1 3 1 4 2 3 2 4 3 4\n";
+  std::string run = (work_dir / "run").string();
+
+  EXPECT_EQ(RunShardedEnumeration(triangles.string() + " " + run + " 3"), "anticliques: 27\n3-colorable: yes\n");
+  EXPECT_EQ(RunShardedEnumeration(full.string() + " " + run + " 3"), "anticliques: 4\n3-colorable: no\n");
+  EXPECT_EQ(RunShardedEnumeration(full.string() + " " + run + " 2"), "anticliques: 4\n3-colorable: no\n");
+  EXPECT_NE(RunShardedEnumeration(triangles.string() + " " + run + " 2 --merge"),
+            "anticliques: 27\n3-colorable: yes\n");
+
+  EXPECT_EQ(RunShardedEnumeration(triangles.string() + " " + run + " 5 --list"), "anticliques: 27\n3-colorable: yes\n");
+  std::string expected;
+  for (const auto& anticlique : GenerateMaxGraph<9>().ListAllMaxAnticliques()) {
+    for (size_t v = 0; v < 9; ++v) {
+      expected += anticlique[v] ? '1' : '0';
+    }
+    expected += '\n';
+  }
+  std::ifstream merged(work_dir / "run" / "merged.list");
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(merged), {}), expected);
+  std::filesystem::remove_all(work_dir);
+}
+
+TEST(ShardedEnumeration, MergesListsOfListedShardsOnly) {
+  std::filesystem::path work_dir = std::filesystem::temp_directory_path() / "graph3coloring_listed_shards";
+  std::filesystem::remove_all(work_dir);
+  std::filesystem::create_directories(work_dir);
+  std::filesystem::path triangles = work_dir / "triangles.txt";
+  std::ofstream(triangles) << "15 15 1 2 1 3 2 3 4 5 4 6 5 6 7 8 7 9 8 9 10 11 10 12 11 12 13 14 13 15 14 15\n";
+  std::string run = (work_dir / "run").string();
+  std::string expected;
+  for (const auto& anticlique : GenerateMaxGraph<15>().ListAllMaxAnticliques()) {
+    for (size_t v = 0; v < 15; ++v) {
+      expected += anticlique[v] ? '1' : '0';
+    }
+    expected += '\n';
+  }
+
+  EXPECT_EQ(RunShardedEnumeration(triangles.string() + " " + run + " 8"), "anticliques: 243\n3-colorable: yes\n");
+  EXPECT_EQ(RunShardedEnumeration(triangles.string() + " " + run + " 8 --merge --list"),
+            "shard 0 was run without --list\n");
+
+  // Shards run without --list start over, and the runs are merged in passes
+  // when they do not fit under the open file limit
+  EXPECT_EQ(RunShardedEnumeration(triangles.string() + " " + run + " 8 --list", 20),
+            "anticliques: 243\n3-colorable: yes\n");
+  std::ifstream merged(work_dir / "run" / "merged.list");
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(merged), {}), expected);
+  std::filesystem::remove_all(work_dir);
+}
+
+#endif
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();